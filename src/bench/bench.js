@@ -0,0 +1,97 @@
+// jsh-bench, runs the hot paths of the shell without a terminal and writes
+// the results as JSON to stdout or to the file given with --out
+//
+//   node bench.js [--out file] [--iterations n] [--only suite,...]
+//
+// progress goes to stderr. nothing here needs a tty, pipelines run as
+// background jobs and completion is timed at the callback ReadLine calls
+var fs = require('fs');
+var os = require('os');
+var jshNative = require('jsh');
+
+var suites = {
+  spawn: require('./spawn'),
+  read: require('./read'),
+  records: require('./records'),
+  exit: require('./exit'),
+  completion: require('./completion'),
+  tokenizer: require('./tokenizer'),
+  startup: require('./startup')
+};
+
+var options = { iterations: 50, out: undefined, only: undefined };
+for (var i = 2; i < process.argv.length; ++i) {
+  var arg = process.argv[i];
+  if (arg === '--out') {
+    options.out = process.argv[++i];
+  } else if (arg === '--iterations') {
+    options.iterations = parseInt(process.argv[++i]);
+  } else if (arg === '--only') {
+    options.only = process.argv[++i].split(',');
+  } else {
+    console.error('usage: bench.js [--out file] [--iterations n] [--only ' + Object.keys(suites).join(',') + ']');
+    process.exit(1);
+  }
+}
+
+// the suites share the one jsh object there can be
+jsh = {
+  jshNative: new jshNative.jsh(),
+  log: function() { },
+  pathify: function(prog) {
+    if (prog.indexOf('/') !== -1)
+      return prog;
+    var resolved = jsh.jshNative.resolve(prog, process.env.PATH);
+    if (resolved === undefined)
+      throw 'File not found: ' + prog;
+    return resolved;
+  },
+  pathifyAll: function(progs) {
+    return progs.map(jsh.pathify);
+  },
+  IFS: '\n'
+};
+// the same setup jsh.js does, without a tty on stdin it only opens the
+// wakeup pipe and leaves the terminal alone
+jsh.jshNative.setupShell();
+
+var report = {
+  name: 'jsh-bench',
+  date: new Date().toISOString(),
+  node: process.version,
+  platform: os.platform() + ' ' + os.release(),
+  cpus: os.cpus().length,
+  iterations: options.iterations,
+  results: {}
+};
+
+var names = Object.keys(suites).filter(function(name) {
+  return !options.only || options.only.indexOf(name) !== -1;
+});
+
+function next(idx) {
+  if (idx === names.length) {
+    var json = JSON.stringify(report, null, 2) + '\n';
+    if (options.out) {
+      fs.writeFileSync(options.out, json);
+      console.error('wrote ' + options.out);
+    } else {
+      process.stdout.write(json);
+    }
+    jsh.jshNative.cleanup();
+    return;
+  }
+  var name = names[idx];
+  console.error('running ' + name);
+  suites[name](options, function(err, result) {
+    if (err) {
+      console.error(name + ' failed: ' + err);
+      report.results[name] = { error: String(err) };
+    } else {
+      report.results[name] = result;
+    }
+    next(idx + 1);
+  });
+}
+
+next(0);
@@ -0,0 +1,73 @@
+// file completion in large directories, timed at the complete callback that
+// ReadLine::handleComplete calls. the first completion in a directory reads
+// it (cold), the others are served from the directory cache (warm)
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var Completion = require('Completion');
+var stats = require('./stats');
+
+var sizes = [1000, 10000, 50000];
+
+function removeAll(dir) {
+  var names = fs.readdirSync(dir);
+  for (var i = 0; i < names.length; ++i) {
+    var p = path.join(dir, names[i]);
+    if (fs.statSync(p).isDirectory())
+      removeAll(p);
+    else
+      fs.unlinkSync(p);
+  }
+  fs.rmdirSync(dir);
+}
+
+module.exports = function(options, cb) {
+  var root = path.join(os.tmpdir(), 'jsh-bench-' + process.pid);
+  fs.mkdirSync(root);
+  var dirs = [];
+  for (var s = 0; s < sizes.length; ++s) {
+    var dir = path.join(root, String(sizes[s]));
+    fs.mkdirSync(dir);
+    for (var i = 0; i < sizes[s]; ++i)
+      fs.writeFileSync(path.join(dir, 'file' + i), '');
+    // a few directories so completion has to tell them apart
+    for (i = 0; i < 10; ++i)
+      fs.mkdirSync(path.join(dir, 'dir' + i));
+    dirs.push(dir);
+  }
+
+  var completion = new Completion.Completion();
+  var results = [];
+
+  function complete(dir, prefix) {
+    var comp = dir + '/' + prefix;
+    var text = 'ls ' + comp;
+    var start = process.hrtime();
+    completion.complete({ text: text, comp: comp, start: 3, end: text.length });
+    return stats.since(start);
+  }
+
+  function run(idx) {
+    if (idx === dirs.length) {
+      removeAll(root);
+      return cb(null, results);
+    }
+    var dir = dirs[idx];
+    var cold = complete(dir, 'file1');
+    stats.repeat(options.iterations, function(done) {
+      done(null, complete(dir, 'file1'));
+    }, function(err, samples) {
+      if (err)
+        return cb(err);
+      var result = stats.summarize(samples, 'ms');
+      result.entries = sizes[idx];
+      result.cold = Math.round(cold * 1000) / 1000;
+      results.push(result);
+      run(idx + 1);
+    });
+  }
+
+  // directories modified within the last second are read again every time,
+  // wait that out so the warm numbers are warm
+  setTimeout(function() { run(0); }, 2100);
+};
@@ -0,0 +1,30 @@
+// how long it takes for a child exiting to reach JS. the child writes a
+// line and exits right away, the time between the line and the child
+// notification is what reaping and notifying costs
+var pc = require('ProcessChain');
+var stats = require('./stats');
+
+var Background = 2;
+
+module.exports = function(options, cb) {
+  var echo = jsh.pathify('echo');
+  stats.repeat(options.iterations, function(done) {
+    var chain = new pc.ProcessChain(jsh.jshNative);
+    chain.type = Background;
+    chain.chain({ program: echo, arguments: ['x'] });
+    var output;
+    chain.exec(function(data) {
+      if (data.type === 'stdout' && !output) {
+        output = process.hrtime();
+      } else if (data.type === 'child') {
+        if (!output)
+          return done('no output before the exit notification');
+        done(null, stats.since(output));
+      }
+    });
+  }, function(err, samples) {
+    if (err)
+      return cb(err);
+    cb(null, stats.summarize(samples, 'ms'));
+  });
+};
@@ -0,0 +1,34 @@
+// how fast output of a process gets through ReadThread into JS buffers
+var pc = require('ProcessChain');
+var stats = require('./stats');
+
+var Background = 2;
+var Size = 64 * 1024 * 1024;
+
+module.exports = function(options, cb) {
+  var head = jsh.pathify('head');
+  var runs = Math.max(3, Math.ceil(options.iterations / 10));
+  stats.repeat(runs, function(done) {
+    var chain = new pc.ProcessChain(jsh.jshNative);
+    chain.type = Background;
+    chain.chain({ program: head, arguments: ['-c', String(Size), '/dev/zero'] });
+    var bytes = 0, chunks = 0;
+    var start = process.hrtime();
+    chain.exec(function(data) {
+      if (data.type === 'stdout') {
+        bytes += data.data.length;
+        ++chunks;
+      } else if (data.type === 'child') {
+        if (bytes !== Size)
+          return done('got ' + bytes + ' bytes, expected ' + Size);
+        done(null, bytes / (1024 * 1024) / (stats.since(start) / 1000));
+      }
+    }, { encoding: 'buffer' });
+  }, function(err, samples) {
+    if (err)
+      return cb(err);
+    var result = stats.summarize(samples, 'MB/s');
+    result.bytes = Size;
+    cb(null, result);
+  });
+};
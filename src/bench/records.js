@@ -0,0 +1,41 @@
+// lines per second through a JavaScript stage and how much the process
+// grew while doing it, the input is split natively so it shouldn't grow
+var Job = require('Job');
+var stats = require('./stats');
+
+var Lines = 2000000;
+
+module.exports = function(options, cb) {
+  var seq = jsh.pathify('seq');
+  var runs = Math.max(3, Math.ceil(options.iterations / 10));
+  var growth = 0;
+  stats.repeat(runs, function(done) {
+    var job = new Job.Job();
+    job.proc({ program: seq, arguments: ['1', String(Lines)], environment: [], cwd: process.cwd() });
+    job.js(new Job.JavaScript(function*() {
+      var count = 0, lines;
+      while ((lines = yield Job.BATCH) !== undefined)
+        count += lines.length;
+      return count;
+    }));
+    var out = '';
+    var rss = process.memoryUsage().rss;
+    var start = process.hrtime();
+    job.exec(Job.BACKGROUND, function(data) {
+      out += data;
+    }, function() {
+      var ms = stats.since(start);
+      growth = Math.max(growth, process.memoryUsage().rss - rss);
+      if (parseInt(out) !== Lines)
+        return done('got ' + out.trim() + ' lines, expected ' + Lines);
+      done(null, Lines / (ms / 1000));
+    });
+  }, function(err, samples) {
+    if (err)
+      return cb(err);
+    var result = stats.summarize(samples, 'lines/s');
+    result.lines = Lines;
+    result.rssGrowth = growth;
+    cb(null, result);
+  });
+};
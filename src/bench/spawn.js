@@ -0,0 +1,38 @@
+// time from exec until a pipeline of 1 to 16 no-op stages has exited
+var pc = require('ProcessChain');
+var stats = require('./stats');
+
+var Background = 2;
+
+module.exports = function(options, cb) {
+  var truePath = jsh.pathify('true');
+  var catPath = jsh.pathify('cat');
+  var lengths = [1, 2, 4, 8, 16];
+  var results = [];
+
+  function run(idx) {
+    if (idx === lengths.length)
+      return cb(null, results);
+    var stages = lengths[idx];
+    stats.repeat(options.iterations, function(done) {
+      var chain = new pc.ProcessChain(jsh.jshNative);
+      chain.type = Background;
+      chain.chain({ program: truePath, arguments: [] });
+      for (var i = 1; i < stages; ++i)
+        chain.chain({ program: catPath, arguments: [] });
+      var start = process.hrtime();
+      chain.exec(function(data) {
+        if (data.type === 'child')
+          done(null, stats.since(start));
+      });
+    }, function(err, samples) {
+      if (err)
+        return cb(err);
+      var result = stats.summarize(samples, 'ms');
+      result.stages = stages;
+      results.push(result);
+      run(idx + 1);
+    });
+  }
+  run(0);
+};
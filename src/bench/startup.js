@@ -0,0 +1,105 @@
+// how long jsh takes to start, run one command and exit without a terminal.
+// every run is a fresh node running jsh.js -c true. uncached compiles all
+// modules from scratch, cold is the first run with an empty code cache
+// (compiling and writing the cache) and warm runs from a full cache. the
+// phases jsh reports with JSH_STARTUP_TIMES show where the time goes
+var fs = require('fs');
+var os = require('os');
+var path = require('path');
+var stats = require('./stats');
+
+var jshjs = path.join(__dirname, '..', 'jsh.js');
+
+function removeAll(dir) {
+  var names = fs.readdirSync(dir);
+  for (var i = 0; i < names.length; ++i)
+    fs.unlinkSync(path.join(dir, names[i]));
+  fs.rmdirSync(dir);
+}
+
+// runs jsh once, returns { wall, startup } or a string on failure
+function run(cache) {
+  process.env.JSH_CODE_CACHE = cache;
+  process.env.JSH_STARTUP_TIMES = '1';
+  var start = process.hrtime();
+  var result = jsh.jshNative.execSync(process.execPath, process.execArgv.concat([jshjs, '-c', 'true']));
+  var wall = stats.since(start);
+  if (result.error || result.code !== 0)
+    return 'jsh -c true failed: ' + (result.error || result.stderr || result.code);
+  var lines = (result.stderr || '').split('\n');
+  for (var i = 0; i < lines.length; ++i) {
+    if (lines[i].charAt(0) === '{')
+      return { wall: wall, startup: JSON.parse(lines[i]) };
+  }
+  return 'no startup times from jsh';
+}
+
+function measure(count, cacheFor, cb) {
+  var wall = [];
+  var phases = {};
+  for (var i = 0; i < count; ++i) {
+    var r = run(cacheFor(i));
+    if (typeof r === 'string')
+      return cb(r);
+    wall.push(r.wall);
+    // the time spent in each phase rather than the time it ended at
+    var prev = 0;
+    var all = r.startup.phases.concat([{ name: 'node', ms: r.startup.uptime - r.startup.total }]);
+    for (var p = 0; p < all.length; ++p) {
+      var ms = all[p].name === 'node' ? all[p].ms : all[p].ms - prev;
+      if (all[p].name !== 'node')
+        prev = all[p].ms;
+      (phases[all[p].name] || (phases[all[p].name] = [])).push(ms);
+    }
+  }
+  var ret = { wall: stats.summarize(wall, 'ms'), phases: {} };
+  for (var name in phases)
+    ret.phases[name] = stats.summarize(phases[name], 'ms');
+  cb(null, ret);
+}
+
+module.exports = function(options, cb) {
+  var root = path.join(os.tmpdir(), 'jsh-bench-cache-' + process.pid);
+  var saved = { cache: process.env.JSH_CODE_CACHE, times: process.env.JSH_STARTUP_TIMES };
+  var result = {};
+  var dirs = [];
+  function done(err) {
+    for (var i = 0; i < dirs.length; ++i) {
+      try {
+        removeAll(dirs[i]);
+      } catch (e) {
+      }
+    }
+    process.env.JSH_CODE_CACHE = saved.cache;
+    process.env.JSH_STARTUP_TIMES = saved.times;
+    if (saved.cache === undefined)
+      delete process.env.JSH_CODE_CACHE;
+    if (saved.times === undefined)
+      delete process.env.JSH_STARTUP_TIMES;
+    cb(err, err ? undefined : result);
+  }
+
+  measure(options.iterations, function() { return 'off'; }, function(err, r) {
+    if (err)
+      return done(err);
+    result.uncached = r;
+    measure(Math.min(options.iterations, 10), function(i) {
+      var dir = root + '-' + i;
+      dirs.push(dir);
+      return dir;
+    }, function(err, r) {
+      if (err)
+        return done(err);
+      result.cold = r;
+      var warm = root + '-warm';
+      dirs.push(warm);
+      run(warm);
+      measure(options.iterations, function() { return warm; }, function(err, r) {
+        if (err)
+          return done(err);
+        result.warm = r;
+        done(null);
+      });
+    });
+  });
+};
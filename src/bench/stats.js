@@ -0,0 +1,53 @@
+// helpers shared by the suites
+
+// milliseconds since start, start being a process.hrtime() value
+function since(start) {
+  var d = process.hrtime(start);
+  return d[0] * 1e3 + d[1] / 1e6;
+}
+
+function round(v) {
+  return Math.round(v * 1000) / 1000;
+}
+
+// min, mean, max and nearest rank percentiles of samples
+function summarize(samples, unit) {
+  var sorted = samples.slice().sort(function(a, b) { return a - b; });
+  var sum = 0;
+  for (var i = 0; i < sorted.length; ++i)
+    sum += sorted[i];
+  function pct(p) {
+    if (!sorted.length)
+      return undefined;
+    var idx = Math.ceil(p / 100 * sorted.length) - 1;
+    return round(sorted[Math.max(0, Math.min(idx, sorted.length - 1))]);
+  }
+  return {
+    unit: unit,
+    samples: sorted.length,
+    min: round(sorted[0]),
+    mean: round(sorted.length ? sum / sorted.length : 0),
+    p50: pct(50),
+    p90: pct(90),
+    p99: pct(99),
+    max: round(sorted[sorted.length - 1])
+  };
+}
+
+// runs fn(done) count times one after another, fn passes done(err, sample)
+function repeat(count, fn, cb) {
+  var samples = [];
+  function one() {
+    if (samples.length === count)
+      return cb(null, samples);
+    fn(function(err, sample) {
+      if (err)
+        return cb(err);
+      samples.push(sample);
+      one();
+    });
+  }
+  one();
+}
+
+module.exports = { since: since, summarize: summarize, repeat: repeat };
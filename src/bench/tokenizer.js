@@ -0,0 +1,73 @@
+// throughput of Tokenizer.js over a corpus of shell and script lines and
+// over 64k lines, with and without the native scanner
+var Tokenizer = require('Tokenizer');
+var stats = require('./stats');
+
+var lines = [
+  'ls -l > out.txt 2>&1',
+  'echo "hello world" | grep \'hel\\\'lo\' && cat ~/foo',
+  'git log --oneline -n 20 | head -5 | sed -e "s/^/  /"',
+  'cd ~/src/jsh; make -j8 && ./jsh --version',
+  'for (var i = 0; i < 10; ++i) console.log(i);',
+  'find . -name "*.cpp" -o -name "*.h" | xargs grep -n TODO',
+  'a=b, c<d >> e && f || g',
+  'var x = function(a, b) { return a + b; }; x(1, 2)'
+];
+
+function corpus() {
+  var ret = [], bytes = 0;
+  for (var i = 0; i < 20000; ++i) {
+    var line = lines[i % lines.length] + ' arg' + i;
+    ret.push(line);
+    bytes += Buffer.byteLength(line);
+  }
+  return { lines: ret, bytes: bytes };
+}
+
+// a pasted script on one line, a scanner that rescans or copies what it
+// has already seen shows here
+function longLines() {
+  var line = '';
+  while (line.length < 64 * 1024)
+    line += 'some --command "with a quoted arg" | and a pipe > /dev/null; ';
+  var ret = [];
+  for (var i = 0; i < 16; ++i)
+    ret.push(line);
+  return { lines: ret, bytes: ret.length * Buffer.byteLength(line) };
+}
+
+function tokenizeAll(c) {
+  var tok = new Tokenizer.Tokenizer(Tokenizer.SHELL);
+  for (var i = 0; i < c.lines.length; ++i) {
+    tok.tokenize(c.lines[i]);
+    while (tok.next()) { }
+  }
+}
+
+module.exports = function(options, cb) {
+  var inputs = { corpus: corpus(), '64k lines': longLines() };
+  var runs = Math.max(3, Math.ceil(options.iterations / 5));
+  var results = [];
+  var impls = Tokenizer.hasNative() ? [false, true] : [false];
+
+  for (var n = 0; n < impls.length; ++n) {
+    Tokenizer.setNative(impls[n]);
+    for (var name in inputs) {
+      var c = inputs[name];
+      tokenizeAll(c);
+      var samples = [];
+      for (var r = 0; r < runs; ++r) {
+        var start = process.hrtime();
+        tokenizeAll(c);
+        samples.push(c.bytes / (1024 * 1024) / (stats.since(start) / 1000));
+      }
+      var result = stats.summarize(samples, 'MB/s');
+      result.impl = impls[n] ? 'native' : 'js';
+      result.input = name;
+      result.lines = c.lines.length;
+      results.push(result);
+    }
+  }
+  Tokenizer.setNative(true);
+  cb(null, results);
+};
@@ -1,14 +1,17 @@
 // var jsh, global, __filename, require, process;
 
-var rl = require('ReadLine');
+var startup = process.hrtime();
+var startupPhases = [];
+var jshnative = require('jsh');
+// JSH_CODE_CACHE=off compiles everything from scratch
+var codeCache = process.env.JSH_CODE_CACHE || process.env.HOME + '/.jsh/cache';
+if(codeCache !== 'off') require('CodeCache').install(__dirname + '/node_modules/', codeCache);
 var pc = require('ProcessChain');
 var Job = require('Job');
-var Completion = require('Completion');
 var Tokenizer = require('Tokenizer');
-var jshnative = require('jsh');
 var path = require('path');
 var fs = require('fs');
-//var Service = require('Service');
+var os = require('os');
 var ifsOverrideStack = [];
 jsh = {
   get IFS() {
@@ -18,29 +21,74 @@ jsh = {
   jshNative: new jshnative.jsh(),
   Job: Job,
   jobCount: 0,
-  completion: new Completion.Completion(),
+  _completion: undefined,
+  _completionSetup: [],
+  // loaded the first time something completes or registers a completer
+  get completion() {
+    if(!this._completion) {
+      var Completion = require('Completion');
+      this._completion = new Completion.Completion();
+      for(var i = 0; i < this._completionSetup.length; ++i) this._completionSetup[i](this._completion);
+      this._completionSetup = [];
+    }
+    return this._completion;
+  },
+  // fn(completion) runs once completion is loaded
+  onCompletion: function(fn) {
+    if(this._completion) fn(this._completion);
+    else this._completionSetup.push(fn);
+  },
+  // services are only loaded once one is asked for
+  registerService: function(name, options, cb) {
+    return require('Service').registerService(name, options, cb);
+  },
   pathify: function(prog) {
     if(prog.indexOf('/') == -1) {
-      // check PATH
+      // look it up in the command hash
       var path = global.PATH;
       if(typeof path !== 'string') {
         // throw here?
         return '';
       }
-      // split on ':'
-      path = path.split(':');
-      for(var i in path) {
-        if(jsh.jshNative.isExecutable(path[i] + '/' + prog)) prog = path[i] + '/' + prog;
-      }
-      if(prog.indexOf('/') == -1) {
+      var resolved = jsh.jshNative.resolve(prog, path);
+      if(resolved === undefined) {
         throw 'File not found: ' + prog;
       }
+      return resolved;
     } else if(!jsh.jshNative.isExecutable(prog)) {
       throw 'File not found: ' + prog;
     }
 
     return prog;
   },
+  // resolves the programs of a whole job with one native call
+  pathifyAll: function(progs) {
+    var path = global.PATH;
+    if(typeof path !== 'string') {
+      return progs.map(function() {
+        return '';
+      });
+    }
+    var lookup = [];
+    for(var i = 0; i < progs.length; ++i) {
+      if(progs[i].indexOf('/') == -1) lookup.push(progs[i]);
+    }
+    var resolved = lookup.length ? jsh.jshNative.resolveAll(lookup, path) : [];
+    var ret = [];
+    for(i = 0; i < progs.length; ++i) {
+      var prog = progs[i];
+      if(prog.indexOf('/') == -1) {
+        prog = resolved.shift();
+        if(prog === undefined) {
+          throw 'File not found: ' + progs[i];
+        }
+      } else if(!jsh.jshNative.isExecutable(prog)) {
+        throw 'File not found: ' + prog;
+      }
+      ret.push(prog);
+    }
+    return ret;
+  },
   config: {
     logEnabled: false,
     expandVariables: true,
@@ -68,8 +116,33 @@ jsh = {
   setPrompt: function(p) {
     this._userPrompt = p;
   },
-  execSync: function(cmd, args) {
-    return this.jshNative.execSync(this.pathify(cmd), args);
+  execSync: function(cmd, args, options) {
+    return this.jshNative.execSync(this.pathify(cmd), args, options);
+  },
+  // runs cmd off the main thread, options can have maxBuffer and timeout.
+  // without a callback a promise for the result is returned
+  exec: function(cmd, args, options, cb) {
+    if(typeof options === 'function') {
+      cb = options;
+      options = undefined;
+    }
+    var prog = this.pathify(cmd);
+    if(cb) {
+      this.jshNative.exec(prog, args, options, cb);
+      return undefined;
+    }
+    var native = this.jshNative;
+    var Promise = require('promise');
+    return new Promise(function(resolve, reject) {
+      native.exec(prog, args, options, function(err, result) {
+        if(err) {
+          err.result = result;
+          reject(err);
+        } else {
+          resolve(result);
+        }
+      });
+    });
   }
 };
 jsh.jshNative.setupShell();
@@ -270,13 +343,137 @@ function jsReturn(ret) {
   return !!ret;
 }
 
+function isRedirection(op) {
+  return op === '<' || op === '>' || op === '>>' || op === '<&' || op === '>&';
+}
+
+// parses the redirection operator at token[idx] and its target into
+// redirections, a fd number right in front of the operator is taken out
+// of args. returns the index of the last token used
+function parseRedirection(token, idx, args, redirections) {
+  var op = token[idx];
+  var fd = op.data[0] === '<' ? 0 : 1;
+  var prev = idx > 0 ? token[idx - 1] : undefined;
+  if(
+    prev !== undefined &&
+    prev.type === Tokenizer.COMMAND &&
+    prev.to === op.from &&
+    /^[0-9]$/.test(prev.data) &&
+    args.length &&
+    args[args.length - 1] === prev.data
+  ) {
+    fd = parseInt(args.pop());
+  }
+
+  var next = idx + 1;
+  while(next < token.length && token[next].type === Tokenizer.HIDDEN) ++next;
+  if(next >= token.length) {
+    throw 'Missing target for ' + op.data;
+  }
+  var target = token[next].data;
+  // skip the closing quote
+  if(next + 1 < token.length && token[next + 1].type === Tokenizer.HIDDEN && token[next + 1].data === "'") ++next;
+
+  switch (op.data) {
+    case '<&':
+    case '>&':
+      if(!/^[0-9]$/.test(target)) {
+        throw 'Invalid file descriptor for ' + op.data + ': ' + target;
+      }
+      redirections.push({ fd: fd, dup: parseInt(target) });
+      break;
+    case '<':
+      redirections.push({ fd: fd, file: path.resolve(target), mode: 'read' });
+      break;
+    case '>':
+      redirections.push({ fd: fd, file: path.resolve(target), mode: 'truncate' });
+      break;
+    case '>>':
+      redirections.push({ fd: fd, file: path.resolve(target), mode: 'append' });
+      break;
+  }
+  return next;
+}
+
+// parallel [-j copies] [-k] [--load] command args... runs copies of command
+// and hands each line of the input to one of them. -k keeps the output in
+// the order of the input, which needs command to write a line per line,
+// --load gives lines to whichever copy keeps up best instead of taking turns
+function parseParallel(args) {
+  var opts = { copies: Math.min(os.cpus().length, 256), order: 'unordered', distribute: 'roundrobin', separator: jsh.IFS };
+  while(args.length && args[0][0] === '-') {
+    var arg = args.shift();
+    if(arg === '-j') {
+      opts.copies = parseInt(args.shift());
+      if(isNaN(opts.copies) || opts.copies < 1) throw 'parallel: -j needs a number';
+    } else if(arg === '-k') {
+      opts.order = 'ordered';
+    } else if(arg === '--load') {
+      opts.distribute = 'load';
+    } else {
+      throw 'parallel: unknown option ' + arg;
+    }
+  }
+  if(!args.length) throw 'parallel: missing command';
+  return { program: args.shift(), arguments: args, parallel: opts };
+}
+
+function msSince(start) {
+  var d = process.hrtime(start);
+  return d[0] * 1e3 + d[1] / 1e6;
+}
+
+function padRight(str, len) {
+  while(str.length < len) str += ' ';
+  return str;
+}
+
+function formatSeconds(ms) {
+  var min = Math.floor(ms / 60000);
+  return min + 'm' + ((ms - min * 60000) / 1000).toFixed(3) + 's';
+}
+
+// what 'time' prints, the totals like other shells and a line per process
+// and JavaScript stage when there is more than one
+function printTimes(start, times) {
+  var user = 0,
+    sys = 0,
+    lines = [];
+  for(var i = 0; i < times.length; ++i) {
+    var t = times[i];
+    if(t.type === 'js') {
+      // JavaScript runs on our thread, its time is all user time
+      user += t.real;
+      lines.push(padRight('  <javascript>', 20) + ' real ' + formatSeconds(t.real));
+      continue;
+    }
+    user += t.usage.user;
+    sys += t.usage.system;
+    for(var p = 0; p < t.processes.length; ++p) {
+      var u = t.processes[p];
+      lines.push(
+        padRight('  ' + path.basename(u.program || '?'), 20) +
+          ' user ' + formatSeconds(u.user) +
+          ' sys ' + formatSeconds(u.system) +
+          ' maxrss ' + u.maxRss + 'k' +
+          ' faults ' + u.minorFaults + '/' + u.majorFaults +
+          ' switches ' + u.voluntarySwitches + '/' + u.involuntarySwitches
+      );
+    }
+  }
+  console.error('\nreal\t' + formatSeconds(msSince(start)));
+  console.error('user\t' + formatSeconds(user));
+  console.error('sys\t' + formatSeconds(sys));
+  if(lines.length > 1) console.error(lines.join('\n'));
+}
+
 function runTokens(tokens, pos) {
   if(pos === tokens.length) {
     runState.pop();
     return;
   }
 
-  var job, j;
+  var job, j, timed;
   for(var i = pos; i < tokens.length; ++i) {
     var token = tokens[i];
     var op = operator(token);
@@ -288,6 +485,12 @@ function runTokens(tokens, pos) {
     // remove the operator
     token.pop();
 
+    // 'time' in front of a command or pipeline, it's reported when the job is done
+    if(!job && token.length > 1 && token[0].type === Tokenizer.COMMAND && token[0].data === 'time') {
+      token.shift();
+      timed = process.hrtime();
+    }
+
     jsh.log('operator ' + op);
     if(op === '|') {
       if(!job) {
@@ -325,15 +528,19 @@ function runTokens(tokens, pos) {
       }
     }
     if(!iscmd) {
+      var jsTimed = job ? undefined : timed;
+      if(jsTimed) timed = undefined;
       if(hasWait(ret)) {
         jsh.log('pushing...');
         runState.push(function(ret) {
           jsh.log('done!');
+          if(jsTimed) printTimes(jsTimed, [{ type: 'js', real: msSince(jsTimed) }]);
           if(runState.checkOperator(op, ret)) runTokens(tokens, pos + 1);
           else runState.pop();
         });
         return;
       }
+      if(jsTimed) printTimes(jsTimed, [{ type: 'js', real: msSince(jsTimed) }]);
       if(runState.checkOperator(op, jsReturn(ret))) {
         continue;
       } else {
@@ -344,13 +551,27 @@ function runTokens(tokens, pos) {
     jsh.log('  is a command');
     var cmd = undefined;
     var args = [];
+    var redirections = [];
+    var overrides = undefined;
     for(j = 0; j < token.length; ++j) {
-      if(cmd === undefined) {
+      if(token[j].type === Tokenizer.OPERATOR && isRedirection(token[j].data)) {
+        j = parseRedirection(token, j, args, redirections);
+      } else if(cmd === undefined && /^[A-Za-z_][A-Za-z0-9_]*=/.test(token[j].data)) {
+        // NAME=value before the command only goes to that command
+        (overrides || (overrides = [])).push(token[j].data);
+      } else if(cmd === undefined) {
         cmd = token[j].data;
       } else if(token[j].type !== Tokenizer.HIDDEN) {
         args.push(token[j].data);
       }
     }
+    var parallel;
+    if(cmd === 'parallel') {
+      var par = parseParallel(args);
+      cmd = par.program;
+      args = par.arguments;
+      parallel = par.parallel;
+    }
     if(cmd !== undefined) {
       jsh.log('execing cmd ' + cmd);
       try {
@@ -358,16 +579,23 @@ function runTokens(tokens, pos) {
           job.proc({
             program: cmd,
             arguments: args,
-            environment: jsh.environment(),
-            cwd: process.cwd()
+            environment: jsh.environmentBlock(),
+            environmentOverrides: overrides,
+            cwd: process.cwd(),
+            redirections: redirections,
+            parallel: parallel
           });
         } else {
           var procjob = new Job.Job();
+          var procTimed = timed;
           procjob.proc({
             program: cmd,
             arguments: args,
-            environment: jsh.environment(),
-            cwd: process.cwd()
+            environment: jsh.environmentBlock(),
+            environmentOverrides: overrides,
+            cwd: process.cwd(),
+            redirections: redirections,
+            parallel: parallel
           });
           procjob.exec(
             Job.FOREGROUND,
@@ -376,6 +604,7 @@ function runTokens(tokens, pos) {
             },
             function(code) {
               if(procjob.type === Job.BACKGROUND) return;
+              if(procTimed) printTimes(procTimed, procjob.times);
               if(runState.checkOperator(op, !code)) {
                 try {
                   runTokens(tokens, pos + 1, runState);
@@ -405,6 +634,7 @@ function runTokens(tokens, pos) {
       },
       function(code) {
         if(job.type === Job.FOREGROUND) {
+          if(timed) printTimes(timed, job.times);
           runState.update(!code);
           runState.pop();
         }
@@ -598,6 +828,19 @@ jsh.environment = function() {
   return env;
 };
 
+// the native environment for commands, only built again when something in
+// it changed so every stage of a pipeline shares the same one
+var environmentCache = { key: undefined, block: undefined };
+jsh.environmentBlock = function() {
+  var env = jsh.environment();
+  var key = env.join('\0');
+  if(key !== environmentCache.key) {
+    environmentCache.key = key;
+    environmentCache.block = new pc.Environment(env);
+  }
+  return environmentCache.block;
+};
+
 function loadRCFile(file) {
   var contents;
   try {
@@ -615,36 +858,145 @@ function loadRCFile(file) {
   return true;
 }
 
-setupEnv();
-setupBuiltins();
-runState = new RunState();
+// where startup went, JSH_STARTUP_TIMES=1 prints it to stderr as JSON
+function startupPhase(name) {
+  startupPhases.push({ name: name, ms: msSince(startup) });
+}
 
-loadRCFile('/etc/jshrc.js');
-loadRCFile(process.env.HOME + '/.jsh/jshrc.js');
+function reportStartup() {
+  if(process.env.JSH_STARTUP_TIMES) {
+    process.stderr.write(JSON.stringify({ total: msSince(startup), uptime: process.uptime() * 1e3, phases: startupPhases }) + '\n');
+  }
+}
 
-// first callback function handles input, the second handles completion
-read = new rl.ReadLine(
-  jsh.prompt(),
-  function(data) {
-    // handle input
-    if(data === undefined) {
-      read.cleanup();
+// jsh -c command or jsh file run those and exit, anything else reads from
+// the terminal if there is one and from stdin if not
+function parseArguments(args) {
+  if(args[0] === '-c') {
+    if(args.length < 2) {
+      console.error('jsh: -c needs an argument');
+      process.exit(2);
+    }
+    return { source: args[1] };
+  }
+  if(args.length) {
+    try {
+      return { source: fs.readFileSync(args[0], { encoding: 'utf8' }).replace(/^#!.*/, '') };
+    } catch(err) {
+      console.error('jsh: ' + args[0] + ': ' + err.message);
+      process.exit(127);
+    }
+  }
+  if(!jsh.jshNative.interactive) return { source: fs.readFileSync('/dev/stdin', { encoding: 'utf8' }) };
+  return {};
+}
+
+// whether the tokenizer sees all of text, a brace, paren or quote that is
+// still open means the statement goes on in the next line
+function isComplete(text) {
+  var tok = new Tokenizer.Tokenizer(Tokenizer.SHELL);
+  try {
+    tok.tokenize(text);
+    while(tok.next());
+  } catch(e) {
+    // anything else is for runLine to report
+    return e !== "Tokenizer didn't end in normal state";
+  }
+  return true;
+}
+
+// splits a script into whole statements, a JavaScript block spanning
+// several lines is one of them
+function scriptStatements(source) {
+  var lines = source.split('\n');
+  var statements = [];
+  var pending;
+  for(var i = 0; i < lines.length; ++i) {
+    pending = pending === undefined ? lines[i] : pending + '\n' + lines[i];
+    if(!pending.trim()) {
+      pending = undefined;
+    } else if(i + 1 === lines.length || isComplete(pending)) {
+      statements.push(pending);
+      pending = undefined;
+    }
+  }
+  return statements;
+}
+
+// runs the statements one after the other and exits with the status of
+// the last one. readline and the history never get loaded
+function runScript(source) {
+  var lines = scriptStatements(source);
+  var status = true;
+  function next(idx) {
+    if(idx === lines.length) {
       Job.cleanup();
       jsh.jshNative.cleanup();
-      process.exit();
+      process.exit(status ? 0 : 1);
     }
-
     try {
-      runState.push(function() {
-        read.resume(jsh.prompt());
+      runState.push(function(s) {
+        status = s;
+        process.nextTick(function() {
+          next(idx + 1);
+        });
       });
-      runLine(data, runState);
+      runLine(lines[idx], runState);
     } catch(e) {
       console.log('e6 ' + e);
-      read.resume(jsh.prompt());
+      status = false;
+      next(idx + 1);
     }
-  },
-  function(data) {
-    return jsh.completion.complete(data);
   }
-);
+  next(0);
+}
+
+startupPhase('modules');
+var script = parseArguments(process.argv.slice(2));
+setupEnv();
+setupBuiltins();
+runState = new RunState();
+startupPhase('builtins');
+
+loadRCFile('/etc/jshrc.js');
+loadRCFile(process.env.HOME + '/.jsh/jshrc.js');
+startupPhase('rc');
+
+if(script.source !== undefined) {
+  reportStartup();
+  runScript(script.source);
+} else {
+  var rl = require('ReadLine');
+  // first callback function handles input, the second handles completion
+  read = new rl.ReadLine(
+    jsh.prompt(),
+    function(data) {
+      // handle input
+      if(data === undefined) {
+        read.cleanup();
+        Job.cleanup();
+        jsh.jshNative.cleanup();
+        process.exit();
+      }
+
+      try {
+        runState.push(function() {
+          read.resume(jsh.prompt());
+        });
+        runLine(data, runState);
+      } catch(e) {
+        console.log('e6 ' + e);
+        read.resume(jsh.prompt());
+      }
+    },
+    function(data) {
+      // slow completers stream their candidates while readline goes on
+      return jsh.completion.complete(data, function(cands, done) {
+        return read.complete(data.id, cands, done);
+      });
+    }
+  );
+  jsh.readLine = read;
+  startupPhase('readline');
+  reportStartup();
+}
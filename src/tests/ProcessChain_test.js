@@ -1,32 +1,198 @@
+var assert = require('assert');
+var fs = require('fs');
+var os = require('os');
 var pc = require('ProcessChain');
 var jshNative = require('jsh');
 jsh = {
   jshNative: new jshNative.jsh()
 };
 
-var obj1 = new pc.ProcessChain(jshNative, 0);
+// each test checks in when its chain is done, one that never finishes
+// fails the run as well
+var pending = {};
+function started(name) {
+  pending[name] = true;
+}
+function finished(name) {
+  assert(pending[name], name + ' finished twice');
+  delete pending[name];
+  console.log(name + ' ok');
+  if (!Object.keys(pending).length)
+    process.exit(0);
+}
+process.on('exit', function() {
+  assert.deepEqual(Object.keys(pending), [], 'unfinished: ' + Object.keys(pending).join(', '));
+});
+setTimeout(function() {
+  assert(false, 'timed out waiting for ' + Object.keys(pending).join(', '));
+}, 30000).unref();
+
+// the exec callback for name, check gets the whole stdout (a Buffer in
+// buffer mode) and the child event
+function collect(name, check) {
+  var chunks = [];
+  started(name);
+  return function(data) {
+    if (data.type === 'stdout') {
+      chunks.push(data.data);
+    } else if (data.type === 'child') {
+      check(chunks.length && Buffer.isBuffer(chunks[0]) ? Buffer.concat(chunks) : chunks.join(''), data);
+      finished(name);
+    }
+  };
+}
+
+var obj1 = new pc.ProcessChain(jsh.jshNative);
 obj1
   .chain({ program: '/bin/ls', arguments: ['/bin'] })
   .chain({ program: '/bin/grep', arguments: ['bz'] });
-obj1.exec(function(data) {
-  console.log(JSON.stringify(data) + '\n');
-});
+obj1.exec(collect('pipe', function(out, child) {
+  assert.equal(child.processes.length, 2);
+  out.split('\n').filter(Boolean).forEach(function(line) {
+    assert.notEqual(line.indexOf('bz'), -1, line);
+  });
+}));
 
-var obj2 = new pc.ProcessChain(jshNative, 0);
+var obj2 = new pc.ProcessChain(jsh.jshNative);
 obj2.chain({
   program: '/bin/bash',
   arguments: ['-c', 'echo $FOO'],
   cwd: '/home',
   environment: ['FOO=bar']
 });
-obj2.exec(function(data) {
-  console.log(JSON.stringify(data) + '\n');
-});
+obj2.exec(collect('environment', function(out, child) {
+  assert.equal(child.code, 0);
+  assert.equal(out, 'bar\n');
+}));
 
-var obj3 = new pc.ProcessChain(jshNative, 0);
+var obj3 = new pc.ProcessChain(jsh.jshNative);
 obj3
   .chain({ program: '/bin/grep', arguments: ['foob'] })
   .write('foobar baz')
+  .exec(collect('grep', function(out, child) {
+    assert.equal(child.code, 0);
+    assert.equal(out, 'foobar baz\n');
+  }));
+
+var obj4 = new pc.ProcessChain(jsh.jshNative);
+obj4
+  .chain({ program: '/usr/bin/head', arguments: ['-c', '65536', '/dev/urandom'] })
+  .exec(collect('buffer', function(out, child) {
+    assert.equal(child.code, 0);
+    assert(Buffer.isBuffer(out));
+    assert.equal(out.length, 65536);
+  }), { encoding: 'buffer' });
+
+// output redirected to a file never reaches the callback, 2>&1 follows the
+// redirection before it and >> adds to what's there
+var redirected = os.tmpdir() + '/ProcessChain_test.' + process.pid;
+new pc.ProcessChain(jsh.jshNative)
+  .chain({ program: '/usr/bin/seq', arguments: ['1', '3'] })
+  .chain({
+    program: '/bin/sh',
+    arguments: ['-c', 'cat; echo err >&2'],
+    redirections: [{ fd: 1, file: redirected, mode: 'truncate' }, { fd: 2, dup: 1 }]
+  })
+  .exec(collect('redirect', function(out, child) {
+    assert.equal(child.code, 0);
+    assert.equal(out, '');
+    assert.equal(fs.readFileSync(redirected, 'utf8'), '1\n2\n3\nerr\n');
+
+    new pc.ProcessChain(jsh.jshNative)
+      .chain({ program: '/bin/echo', arguments: ['more'], redirections: [{ fd: 1, file: redirected, mode: 'append' }] })
+      .exec(collect('append', function(out, child) {
+        assert.equal(child.code, 0);
+        assert.equal(out, '');
+
+        new pc.ProcessChain(jsh.jshNative)
+          .chain({ program: '/bin/cat', redirections: [{ fd: 0, file: redirected }] })
+          .exec(collect('redirect stdin', function(out, child) {
+            assert.equal(child.code, 0);
+            assert.equal(out, '1\n2\n3\nerr\nmore\n');
+            fs.unlinkSync(redirected);
+          }));
+      }));
+  }));
+
+// a file that can't be opened fails the launch instead of the child
+assert.throws(function() {
+  new pc.ProcessChain(jsh.jshNative)
+    .chain({ program: '/bin/cat', redirections: [{ fd: 0, file: '/nonexistent/ProcessChain_test' }] })
+    .exec(function() { });
+}, /nonexistent\/ProcessChain_test: No such file or directory/);
+
+// more than the pipe holds, the rest is queued and written as wc reads
+var big = new Buffer(4 * 1024 * 1024);
+big.fill('x');
+var obj5 = new pc.ProcessChain(jsh.jshNative);
+started('written');
+obj5
+  .chain({ program: '/usr/bin/wc', arguments: ['-c'] })
+  .write(big, function(err) {
+    assert(!err, err);
+    assert.equal(obj5.writeQueued, 0);
+    finished('written');
+  });
+assert(obj5.writeQueued > 0, 'nothing queued');
+obj5.exec(collect('wc', function(out, child) {
+  assert.equal(child.code, 0);
+  assert.equal(parseInt(out), big.length);
+}));
+
+// four copies of sed share the lines of seq, -k style so they come back in order
+var obj6 = new pc.ProcessChain(jsh.jshNative);
+obj6
+  .chain({ program: '/usr/bin/seq', arguments: ['1', '10000'] })
+  .chain({ program: '/bin/sed', arguments: ['-u', 's/$/!/'], parallel: { copies: 4, order: 'ordered' } })
+  .exec(collect('fan-out', function(out, child) {
+    assert.equal(child.code, 0);
+    assert.equal(child.processes.length, 5);
+    var lines = out.split('\n');
+    assert.equal(lines.length, 10001);
+    for (var i = 0; i < 10000; ++i)
+      assert.equal(lines[i], (i + 1) + '!');
+  }));
+
+// the last stage never reads, cleanup() still gets the fan-out thread to
+// give up instead of waiting for it
+var obj8 = new pc.ProcessChain(jsh.jshNative);
+started('fan-out cleanup');
+obj8
+  .chain({ program: '/usr/bin/seq', arguments: ['1', '200000'] })
+  .chain({ program: '/bin/sed', arguments: ['-u', 's/$/!/'], parallel: { copies: 2, order: 'ordered' } })
+  .chain({ program: '/bin/sleep', arguments: ['30'] })
   .exec(function(data) {
-    console.log('grep ' + JSON.stringify(data) + '\n');
+    assert.notEqual(data.type, 'stdout');
   });
+setTimeout(function() {
+  obj8.cleanup();
+  finished('fan-out cleanup');
+}, 500);
+
+// a whole pipeline in one call, the stages share one environment and the
+// second one overrides part of it
+var env = new pc.Environment(['FOO=bar', 'BAZ=qux']);
+var obj7 = new pc.ProcessChain(jsh.jshNative);
+obj7
+  .chainAll([
+    { program: '/bin/sh', arguments: ['-c', 'echo $FOO $BAZ'] },
+    { program: '/bin/sh', arguments: ['-c', 'cat; echo $FOO $BAZ'], environmentOverrides: ['FOO=over', 'BAZ'] }
+  ], env)
+  .exec(collect('chainAll', function(out, child) {
+    assert.equal(child.code, 0);
+    assert.equal(out, 'bar qux\nover\n');
+  }));
+
+// the same packed once and chained twice
+var packed = pc.pack([
+  { program: '/usr/bin/seq', arguments: ['1', '3'] },
+  { program: '/usr/bin/wc', arguments: ['-l'] }
+]);
+[0, 1].forEach(function(run) {
+  new pc.ProcessChain(jsh.jshNative)
+    .chainAll(packed)
+    .exec(collect('packed ' + run, function(out, child) {
+      assert.equal(child.code, 0);
+      assert.equal(out.trim(), '3');
+    }));
+});
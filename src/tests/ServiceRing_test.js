@@ -0,0 +1,72 @@
+// a ring written by whoever created it and read by whoever opened it, with
+// doorbell frames the way Service.js announces each message
+var assert = require('assert');
+var jshNative = require('jsh');
+
+var ring = new jshNative.Ring(4096);
+assert.equal(ring.size, 4096);
+var peer = new jshNative.Ring('/proc/self/fd/' + ring.fd);
+var reader = new jshNative.FrameReader();
+reader.attach(peer);
+
+// a frame with no payload but its encoding, the message is in the ring
+var doorbell = new Buffer([0, 0, 0, 1, 'r'.charCodeAt(0)]);
+
+function message(n, len) {
+  return { n: n, pad: new Array(len + 1).join('x') };
+}
+
+function write(msg, binary) {
+  return binary ? ring.write(msg, true) : ring.write(JSON.stringify(msg));
+}
+
+// odd sizes so the messages end all over the place, the ones that don't
+// fit before the end get wrapped to the front
+var sizes = [1, 7, 100, 333, 1000, 1501];
+var written = 0, bytes = 0;
+for (var round = 0; round < 50; ++round) {
+  // fill it up, the write that fails would have gone over the socket
+  var queued = [];
+  for (;;) {
+    var msg = message(written, sizes[(written + round) % sizes.length]);
+    if (!write(msg, written % 2))
+      break;
+    queued.push(msg);
+    bytes += msg.pad.length;
+    ++written;
+  }
+  assert(queued.length > 0, 'nothing fits in round ' + round);
+
+  // then keep it full while reading, so head and tail both cross the end
+  // with messages in between
+  for (var k = 0; k < 10; ++k) {
+    assert.deepEqual(reader.push(doorbell), [queued.shift()]);
+    msg = message(written, sizes[(written * 7) % sizes.length]);
+    if (write(msg, written % 2)) {
+      queued.push(msg);
+      bytes += msg.pad.length;
+      ++written;
+    }
+  }
+  while (queued.length) {
+    var got = reader.push(doorbell);
+    assert.equal(got.length, 1);
+    assert.deepEqual(got[0], queued.shift());
+  }
+}
+assert(bytes > 20 * 4096, 'only ' + bytes + ' bytes went through');
+
+// bigger than the ring, that one has to go over the socket
+assert.strictEqual(write(message(0, 5000)), false);
+assert.strictEqual(write(message(0, 5000), true), false);
+assert.strictEqual(write(message(1, 10)), true);
+assert.deepEqual(reader.push(doorbell), [message(1, 10)]);
+
+// a doorbell with nothing in the ring breaks the connection
+assert.throws(function() {
+  reader.push(doorbell);
+}, /invalid frame/);
+
+peer.close();
+ring.close();
+console.log('ring ok\n');
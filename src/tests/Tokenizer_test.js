@@ -0,0 +1,75 @@
+// runs a corpus through the native scanner and the JS tokenizer and
+// fails on statements where they disagree
+var assert = require('assert');
+var Tokenizer = require('Tokenizer');
+jsh = { log: function() { } };
+
+if (!Tokenizer.hasNative()) {
+  console.log('NativeTokenizer not built\n');
+  process.exit(1);
+}
+
+var corpus = [
+  'ls -l > out.txt 2>&1',
+  'echo "hello world" | grep \'hel\\\'lo\' && cat ~/foo',
+  'foo a\\ b\\\\c "d \\"e\\" f" \'g\' `date` (x y) {js code;} ; next',
+  'cd ~; ls ~/a/b; echo ~',
+  'a=b, c<d >> e && f || g',
+  'echo $HOME "$PATH" \\$x',
+  'var x = function(a, b) { return a + b; }; x(1, 2)',
+  'for (var i = 0; i < 10; ++i) console.log(i);',
+  'echo "unterminated',
+  '{ unterminated',
+  'echo héllo wörld ☃ | cat',
+  'a\\\\\\\\b\\\\c\\ d',
+  'echo }} )) ]]',
+  'echo a;b;c;;d',
+  'cmd1 | cmd2 | cmd3 & cmd4',
+  'x >& 2 <& 0 >>& 3',
+  '  leading   spaces   '
+];
+
+// and a lot of noise made of the characters the tokenizer cares about
+var alpha = 'abcXYZ019_ "\'`{}()];|&<>=,\\$~/.-+!#%\té☃';
+var seed = 1;
+function rnd(k) {
+  seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+  return seed % k;
+}
+for (var n = 0; n < 5000; ++n) {
+  var len = rnd(60), s = '';
+  for (var j = 0; j < len; ++j)
+    s += alpha[rnd(alpha.length)];
+  corpus.push(s);
+}
+
+function run(line, flags) {
+  var tok = new Tokenizer.Tokenizer(flags), out = [], t;
+  tok.tokenize(line);
+  try {
+    while ((t = tok.next()))
+      out.push(t);
+  } catch (e) {
+    out.push('throw ' + e);
+  }
+  return JSON.stringify(out);
+}
+
+var allFlags = [Tokenizer.SHELL, Tokenizer.SCRIPT, Tokenizer.SHELL | Tokenizer.TOLERANT, Tokenizer.SCRIPT | Tokenizer.TOLERANT];
+var failed = 0;
+allFlags.forEach(function(flags) {
+  corpus.forEach(function(line) {
+    Tokenizer.setNative(true);
+    var a = run(line, flags);
+    Tokenizer.setNative(false);
+    var b = run(line, flags);
+    if (a !== b) {
+      ++failed;
+      console.log('mismatch (' + flags + ') ' + JSON.stringify(line) + '\n  native ' + a + '\n  js     ' + b + '\n');
+    }
+  });
+});
+Tokenizer.setNative(true);
+
+assert.strictEqual(failed, 0, failed + ' mismatches');
+console.log('all match\n');
@@ -0,0 +1,52 @@
+var assert = require('assert');
+var jshNative = require('jsh');
+var native = new jshNative.jsh();
+
+var sync = native.execSync('/bin/echo', ['hello from execSync']);
+assert.equal(sync.code, 0);
+assert.equal(sync.stdout, 'hello from execSync\n');
+assert.equal(sync.error, undefined);
+
+// execSync keeps all of the output unless it's given a maxBuffer
+sync = native.execSync('/usr/bin/head', ['-c', '2000000', '/dev/zero']);
+assert.equal(sync.code, 0);
+assert.equal(sync.stdout.length, 2000000);
+assert.equal(sync.truncated, undefined);
+
+sync = native.execSync('/usr/bin/head', ['-c', '100000', '/dev/zero'], { maxBuffer: 1000 });
+assert(sync.truncated);
+assert.equal(sync.stdout.length, 1000);
+assert.equal(sync.error, 'JSH.execSync maxBuffer exceeded');
+
+var pending = ['exec', 'timeout', 'maxBuffer'];
+function finished(name) {
+  pending.splice(pending.indexOf(name), 1);
+  console.log(name + ' ok');
+}
+process.on('exit', function() {
+  assert.deepEqual(pending, [], 'unfinished: ' + pending.join(', '));
+});
+
+native.exec('/bin/sh', ['-c', 'echo out; echo err >&2; exit 2'], function(err, result) {
+  assert.equal(err, null);
+  assert.equal(result.code, 2);
+  assert.equal(result.stdout, 'out\n');
+  assert.equal(result.stderr, 'err\n');
+  finished('exec');
+});
+
+native.exec('/bin/sleep', ['10'], { timeout: 100 }, function(err, result) {
+  assert(err instanceof Error);
+  assert.equal(err.message, 'JSH.exec timed out');
+  assert(result.timedOut);
+  assert.equal(result.code, undefined);
+  finished('timeout');
+});
+
+native.exec('/usr/bin/head', ['-c', '100000', '/dev/zero'], { maxBuffer: 1000 }, function(err, result) {
+  assert(err instanceof Error);
+  assert.equal(err.message, 'JSH.exec maxBuffer exceeded');
+  assert(result.truncated);
+  assert.equal(result.stdout.length, 1000);
+  finished('maxBuffer');
+});